@@ -0,0 +1,61 @@
+/** @file BitBlastBench.cpp
+ *  @brief Throughput of the bit-blasted net name generation
+ *
+ *  Times appendBitBindings and appendBitNets at the channel widths the bit
+ * level flow uses, on connection names shaped like the ones genConnection
+ * builds, and prints the bindings and bytes generated per second.
+ */
+#include "Emitter.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+static void report(const char *what, int width, long count, std::size_t bytes,
+                   double seconds) {
+  std::cout << what << " width " << width << ": " << count / seconds / 1e6
+            << " M bits/s, " << bytes / seconds / (1 << 20) << " MiB/s"
+            << std::endl;
+}
+
+int main(int argc, char **argv) {
+  long channels = argc > 1 ? std::atol(argv[1]) : 200000;
+  const std::string name("in1");
+  const std::string net("mul_5.out1*Operator*~mul_7.in1*Operator*");
+  BitSuffixTable bits;
+  std::string buf;
+  buf.reserve(EMIT_BUFFER_SIZE * 2);
+  int widths[] = {32, 64};
+
+  for (int width : widths) {
+    std::size_t bytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (long i = 0; i < channels; i++) {
+      appendBitBindings(buf, bits, name, net, width);
+      if (buf.size() >= EMIT_BUFFER_SIZE) {
+        bytes += buf.size();
+        buf.clear();
+      }
+    }
+    bytes += buf.size();
+    buf.clear();
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+    report("appendBitBindings", width, channels * width, bytes,
+           elapsed.count());
+
+    bytes = 0;
+    start = std::chrono::steady_clock::now();
+    for (long i = 0; i < channels; i++) {
+      appendBitNets(buf, bits, net, width);
+      if (buf.size() >= EMIT_BUFFER_SIZE) {
+        bytes += buf.size();
+        buf.clear();
+      }
+    }
+    bytes += buf.size();
+    buf.clear();
+    elapsed = std::chrono::steady_clock::now() - start;
+    report("appendBitNets", width, channels * width, bytes, elapsed.count());
+  }
+}
@@ -0,0 +1,26 @@
+/** @file DotReader.h
+ *  @brief Multi-threaded reader of flat DOT graphs
+ *
+ *  The input is split at statement boundaries (a ';', '{' or '}' outside of
+ * quoted strings, comments and attribute lists) and the chunks are parsed
+ * concurrently into per-chunk node and edge buffers. Node names are resolved
+ * through a concurrent hash table, and the graph is then built with its nodes
+ * in the order of their first appearance in the file, as agread creates them.
+ * Subgraphs are flattened into the root graph: the subgraphs of the root
+ * graph are created, so that agnsubg counts them as after agread, but their
+ * nodes and edges belong to the root graph only.
+ */
+#ifndef __BLIFMAKER_DOTREADER_H__
+#define __BLIFMAKER_DOTREADER_H__
+
+#include <graphviz/cgraph.h>
+#include <string>
+
+/** @brief reads the graph in filePath with jobs threads, at most one per core
+ *  @return the graph, or nullptr when the file uses DOT features the parallel
+ * reader does not handle (default node/edge attributes, ports, HTML strings,
+ * several graphs, ...), in which case it has to be read with agread
+ */
+Agraph_t *readDotParallel(std::string filePath, int jobs);
+
+#endif //__BLIFMAKER_DOTREADER_H__
@@ -0,0 +1,153 @@
+/** @file Emitter.h
+ *  @brief Per-type subckt emitters used by BLIFCircuit::printCircuit
+ *
+ *  Every BLIFCircuit::Type, and every Op of an Operator, has its own emitter
+ * specialized at compile time. The emitter of a node is looked up in the
+ * tables once, when its type and op are set, and stored in its attributes.
+ * An emitter appends the text of the node straight into the output buffer:
+ * the fixed fragments (e.g. ".subckt Fork\\\n") are string literals of the
+ * specialization, and only the connected ports are walked, each with its
+ * "name=" prefix built when the port was parsed.
+ */
+#ifndef __BLIFMAKER_EMITTER_H__
+#define __BLIFMAKER_EMITTER_H__
+
+#include "Node.h"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The output buffer is flushed to the stream once it grows past this size
+#define EMIT_BUFFER_SIZE (1 << 16)
+
+/** @brief The "[i]" suffixes of bit-blasted net names, stored back to back
+ *
+ *  Bit i occupies text[offset[i], offset[i + 1]), so the suffixes of the
+ * first w bits are offset[w] characters long in total and a whole channel can
+ * be sized before it is written.
+ */
+class BitSuffixTable {
+public:
+  explicit BitSuffixTable(int width = 64) : offset(1, 0) { reserve(width); }
+  void reserve(int width);
+  const char *suffix(int i) const { return text.data() + offset[i]; }
+  std::size_t length(int i) const { return offset[i + 1] - offset[i]; }
+  std::size_t totalLength(int width) const { return offset[width]; }
+
+private:
+  std::string text;
+  std::vector<std::size_t> offset;
+};
+
+/** @brief Appends "name[0]=net[0] name[1]=net[1] ..." for width bits */
+void appendBitBindings(std::string &buf, BitSuffixTable &bits,
+                       const std::string &name, const std::string &net,
+                       int width);
+/** @brief Appends "net[0] net[1] ..." for width bits */
+void appendBitNets(std::string &buf, BitSuffixTable &bits,
+                   const std::string &net, int width);
+
+struct EmitContext {
+  std::string indent;      // prefix of the "#Node" and ".subckt" lines
+  std::string indentInner; // prefix of every port binding
+  BitSuffixTable *bits;    // set when channels are bit-blasted
+};
+
+template <std::size_t N>
+inline void appendLiteral(std::string &buf, const char (&s)[N]) {
+  buf.append(s, N - 1);
+}
+
+/** @brief Fixed text of a subckt, one specialization per emitted type */
+template <BLIFCircuit::Type T> struct SubcktText;
+
+#define BLIF_SUBCKT_TEXT(T)                                                    \
+  template <> struct SubcktText<BLIFCircuit::T> {                              \
+    static void header(std::string &buf) {                                     \
+      appendLiteral(buf, ".subckt " #T "\\\n");                                \
+    }                                                                          \
+  };
+BLIF_SUBCKT_TEXT(Operator)
+BLIF_SUBCKT_TEXT(Buffer)
+BLIF_SUBCKT_TEXT(Constant)
+BLIF_SUBCKT_TEXT(Fork)
+BLIF_SUBCKT_TEXT(Merge)
+BLIF_SUBCKT_TEXT(Select)
+BLIF_SUBCKT_TEXT(Branch)
+BLIF_SUBCKT_TEXT(Demux)
+#undef BLIF_SUBCKT_TEXT
+
+/** @brief Architecture specific text of an Operator of op O.
+ *
+ *  It is written right after the .subckt line. Specialize it to emit, for
+ * instance, parameterized widths of a single op; the default emits nothing.
+ */
+template <BLIFCircuit::Op O> struct OperatorParams {
+  static void emit(std::string &, const EmitContext &,
+                   BLIFCircuit::NodeAttr_t *) {}
+};
+
+inline void emitNodeComment(std::string &buf, const EmitContext &ctx,
+                            BLIFCircuit::NodeAttr_t *attrs) {
+  buf += ctx.indent;
+  appendLiteral(buf, "#Node ");
+  buf += attrs->name;
+  buf += '\n';
+}
+
+inline void emitBindings(std::string &buf, const EmitContext &ctx,
+                         BLIFPort *port) {
+  if (!port)
+    return;
+  for (auto io : *port->getBoundPointer()) {
+    buf += ctx.indentInner;
+    if (ctx.bits) {
+      appendBitBindings(buf, *ctx.bits, io->name, io->connection, io->width);
+      continue;
+    }
+    buf += io->prefix;
+    buf += io->connection;
+    buf += ' ';
+  }
+}
+
+inline void emitSkipped(std::string &buf, const EmitContext &ctx,
+                        BLIFCircuit::NodeAttr_t *attrs) {
+  emitNodeComment(buf, ctx, attrs);
+  buf += ctx.indent;
+  appendLiteral(buf, "#Skipped\n");
+}
+
+template <BLIFCircuit::Type T> struct SubcktEmitterImpl {
+  static void emit(std::string &buf, const EmitContext &ctx,
+                   BLIFCircuit::NodeAttr_t *attrs) {
+    emitNodeComment(buf, ctx, attrs);
+    buf += ctx.indent;
+    SubcktText<T>::header(buf);
+    emitBindings(buf, ctx, attrs->inPort);
+    emitBindings(buf, ctx, attrs->outPort);
+    buf += '\n';
+  }
+};
+
+template <BLIFCircuit::Op O> struct OperatorEmitterImpl {
+  static void emit(std::string &buf, const EmitContext &ctx,
+                   BLIFCircuit::NodeAttr_t *attrs) {
+    emitNodeComment(buf, ctx, attrs);
+    buf += ctx.indent;
+    SubcktText<BLIFCircuit::Operator>::header(buf);
+    OperatorParams<O>::emit(buf, ctx, attrs);
+    emitBindings(buf, ctx, attrs->inPort);
+    emitBindings(buf, ctx, attrs->outPort);
+    buf += '\n';
+  }
+};
+
+/** @brief Looks up the emitter of a node in the per-type and per-op tables
+ *
+ *  Called by setType and setOp, and again whenever valid changes, so that
+ * printing a node is a single indirect call.
+ */
+BLIFCircuit::SubcktEmitter getSubcktEmitter(BLIFCircuit::NodeAttr_t *attrs);
+
+#endif //__BLIFMAKER_EMITTER_H__
@@ -18,9 +18,12 @@
 
 #define ATTR_STR "attribtues"
 
-Agraph_t *parseDotFile(std::string filePath, int verbosity);
+/** @brief reads a DOT file, splitting it between jobs threads when jobs > 1 */
+Agraph_t *parseDotFile(std::string filePath, int verbosity, int jobs = 1);
 std::string get_indent_string(int indent);
 class BLIFPort;
+class BitSuffixTable;
+struct EmitContext;
 
 class BLIFCircuit {
 
@@ -44,6 +47,10 @@ public:
                               "Merge",    "Select", "Branch",   "Demux",
                               "Entry",    "Exit"};
   std::string Op_str[7] = {"load", "store", "mul", "add", "icmp", "sub", "and"};
+  struct NodeAttr_t;
+  /** @brief Appends the BLIF text of one node to the output buffer */
+  typedef void (*SubcktEmitter)(std::string &buf, const EmitContext &ctx,
+                                NodeAttr_t *attrs);
   typedef struct NodeAttr_t {
     Agrec_t h;
     std::string name;
@@ -54,12 +61,15 @@ public:
     bool valid;
     BLIFPort *inPort;
     BLIFPort *outPort;
+    SubcktEmitter emitter; // bound by setType/setOp
 
   } NodeAttr_t;
 
   BLIFCircuit(Agraph_t *g, std::string name) : graph(g), name(name){};
   void parseAttributes();
-  void printCircuit(std::ostream &os, int indent = 0);
+  /** @brief prints the netlist, expanding every channel into its bits
+   * (net[0]..net[width - 1]) when bitBlast is set */
+  void printCircuit(std::ostream &os, int indent = 0, bool bitBlast = false);
   /** Architecture specific transformations start */
   /** @brief makes every fork in the circuit a fork2 */
   void makeFork2Single(Agnode_t *node, int level, int target_fanout, int index,
@@ -67,15 +77,31 @@ public:
                        std::vector<Agnode_t *> &successors);
   void makeFork2();
   /** Architecture specific transformations end */
+  /** @brief checks the whole circuit once and reports every error found
+   *
+   *  Reports unknown types and ops, invalid widths, edges to unknown ports,
+   * dangling ports, multiply-driven inputs and width mismatches between the
+   * two ends of an edge. Nodes are checked by jobs threads.
+   * @return the number of errors reported to os
+   */
+  int validate(std::ostream &os, int jobs = 1);
+  /** @brief writes a JSON profile of the graph without converting it
+   *
+   *  Histograms of types, ops, fanin, fanout and port widths, plus the node
+   * and edge counts predicted after store inference and makeFork2, so the
+   * memory and time of a conversion can be sized before running it.
+   */
+  void profile(std::ostream &os);
 private:
   std::string name;
   int channelWidth;
   Agraph_t *graph;
 
-  void printCircuitIO(std::ostream &os, int indent);
-  void printSubckt(std::ostream &os, Agnode_t *model, int indent);
+  void printCircuitIO(std::ostream &os, int indent, BitSuffixTable *bits);
+  void printSubckt(std::string &buf, const EmitContext &ctx, Agnode_t *model);
   void printBlackBoxes(std::ostream &os){};
 
+  void setChannelWidth();
   void setName(Agnode_t *node);
   void setType(Agnode_t *node);
   void setOp(Agnode_t *node);
@@ -90,16 +116,26 @@ private:
 struct BLIFIO {
   // bool mode;
   int width;
+  int index;          // position in its port
   std::string name;
+  std::string prefix; // "name=", written before the connection
   std::string connection;
 };
 class BLIFPort {
 public:
   bool mode;
-  BLIFPort(std::string expr, Agnode_t *n, bool _mode, int _defWidth = 32);
+  BLIFPort(std::string expr, Agnode_t *n, bool _mode, int _defWidth = 32,
+           bool _verbose = true);
+  ~BLIFPort();
+  BLIFPort(const BLIFPort &) = delete;
+  BLIFPort &operator=(const BLIFPort &) = delete;
   std::vector<BLIFIO *> *getIOPointer() { return io; };
+  /** @brief the connected ios, in port order */
+  std::vector<BLIFIO *> *getBoundPointer() { return bound; };
+  void bind(BLIFIO *ioObj, const std::string &connection);
   int getDefaultWidth() { return defWidth; };
   BLIFIO *getBLIFIOByName(std::string name);
+  int getIndexByName(const std::string &name);
   int ioCount() { return io->size(); }
 
 private:
@@ -110,7 +146,9 @@ private:
   std::string name;
 
   int defWidth;
+  bool verbose;
   std::vector<BLIFIO *> *io;
+  std::vector<BLIFIO *> *bound;
   Agnode_t *node;
 };
 #endif //__BLIFMAKER_GRAPH_H__
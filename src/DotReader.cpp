@@ -0,0 +1,589 @@
+/** @file DotReader.cpp
+ *  @brief Function definitions for DotReader.h
+ *
+ *  Reading happens in four steps:
+ *  - one serial scan finds the chunk boundaries and the brace depth at each,
+ *  - every chunk is tokenized and parsed on its own thread,
+ *  - every chunk inserts its node names in a shared lock-free table that
+ *    keeps, per name, the position of its first mention in the file,
+ *  - the graph is built on a single thread in file order.
+ */
+#include "../include/DotReader.h"
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+typedef std::vector<std::pair<std::string, std::string>> DotAttrList;
+
+struct DotNodeStmt {
+  int node;
+  DotAttrList attrs;
+};
+
+struct DotEdgeStmt {
+  int tail;
+  int head;
+  DotAttrList attrs;
+};
+
+struct DotNodeRecord {
+  const std::string *name;
+  std::size_t hash;
+  // (chunk << 32) | local index of the first mention of the node
+  std::atomic<std::uint64_t> first;
+  int id;
+};
+
+struct DotChunk {
+  std::size_t begin;
+  std::size_t end;
+  int depth; // brace depth at begin
+  bool failed;
+
+  bool hasHeader;
+  bool directed;
+  bool strict;
+  std::string graphName;
+  DotAttrList graphAttrs;
+  // (named, name) of every subgraph statement of the root graph
+  std::vector<std::pair<bool, std::string>> subgraphs;
+
+  // Distinct node names in the order of their first mention in the chunk
+  std::vector<std::string> names;
+  std::unordered_map<std::string, int> local;
+  std::vector<DotNodeStmt> nodes;
+  std::vector<DotEdgeStmt> edges;
+
+  std::unique_ptr<DotNodeRecord[]> records;
+  std::vector<DotNodeRecord *> resolved;
+  std::vector<int> ids;
+};
+
+/** Statement boundaries */
+
+static bool isLineStart(const std::string &buf, std::size_t pos) {
+  return pos == 0 || buf[pos - 1] == '\n';
+}
+
+// Returns the position right after the comment starting at pos, or pos
+static std::size_t skipComment(const std::string &buf, std::size_t pos) {
+  std::size_t end = buf.size();
+  if (buf[pos] == '#' && isLineStart(buf, pos)) {
+    std::size_t nl = buf.find('\n', pos);
+    return nl == std::string::npos ? end : nl;
+  }
+  if (buf[pos] != '/' || pos + 1 >= end)
+    return pos;
+  if (buf[pos + 1] == '/') {
+    std::size_t nl = buf.find('\n', pos);
+    return nl == std::string::npos ? end : nl;
+  }
+  if (buf[pos + 1] == '*') {
+    std::size_t close = buf.find("*/", pos + 2);
+    return close == std::string::npos ? end : close + 2;
+  }
+  return pos;
+}
+
+static void splitStatements(const std::string &buf, int jobs,
+                            std::vector<DotChunk> &chunks, int &finalDepth) {
+  std::size_t size = buf.size();
+  std::size_t step = size / jobs + 1;
+  std::size_t nextCut = step;
+  bool inQuote = false;
+  int brackets = 0, depth = 0;
+
+  chunks.push_back(DotChunk());
+  chunks.back().begin = 0;
+  chunks.back().depth = 0;
+  for (std::size_t i = 0; i < size; i++) {
+    char c = buf[i];
+    if (inQuote) {
+      if (c == '\\')
+        i++;
+      else if (c == '"')
+        inQuote = false;
+      continue;
+    }
+    std::size_t skip = skipComment(buf, i);
+    if (skip != i) {
+      i = skip - 1;
+      continue;
+    }
+    if (c == '"')
+      inQuote = true;
+    else if (c == '[')
+      brackets++;
+    else if (c == ']')
+      brackets--;
+    else if (c == '{')
+      depth++;
+    else if (c == '}')
+      depth--;
+    if (brackets == 0 && (c == ';' || c == '{' || c == '}') &&
+        i + 1 >= nextCut && (int)chunks.size() < jobs) {
+      chunks.back().end = i + 1;
+      chunks.push_back(DotChunk());
+      chunks.back().begin = i + 1;
+      chunks.back().depth = depth;
+      nextCut = i + 1 + step;
+    }
+  }
+  chunks.back().end = size;
+  finalDepth = inQuote || brackets ? -1 : depth;
+}
+
+/** Tokenizer */
+
+enum DotTokenKind { DotId, DotEdgeOp, DotPunct, DotEnd, DotBad };
+
+struct DotToken {
+  DotTokenKind kind;
+  char punct;
+  bool quoted;
+  std::string text;
+};
+
+static bool isIdChar(char c) {
+  return std::isalnum((unsigned char)c) || c == '_' || c == '.' ||
+         (unsigned char)c >= 128;
+}
+
+class DotLexer {
+public:
+  DotLexer(const std::string &buf, std::size_t begin, std::size_t end)
+      : buf(buf), pos(begin), end(end) {}
+  DotToken next();
+
+private:
+  const std::string &buf;
+  std::size_t pos;
+  std::size_t end;
+};
+
+DotToken DotLexer::next() {
+  DotToken tok;
+  tok.kind = DotBad;
+  tok.punct = 0;
+  tok.quoted = false;
+  while (pos < end) {
+    std::size_t skip = skipComment(buf, pos);
+    if (skip != pos)
+      pos = skip;
+    else if (std::isspace((unsigned char)buf[pos]))
+      pos++;
+    else
+      break;
+  }
+  if (pos >= end) {
+    tok.kind = DotEnd;
+    return tok;
+  }
+  char c = buf[pos];
+  if (c == '"') {
+    tok.quoted = true;
+    for (pos++; pos < end && buf[pos] != '"'; pos++) {
+      if (buf[pos] == '\\' && pos + 1 < end) {
+        // As in agread: \" is a quote and a backslash-newline is removed
+        if (buf[pos + 1] == '"') {
+          tok.text += '"';
+          pos++;
+          continue;
+        }
+        if (buf[pos + 1] == '\n') {
+          pos++;
+          continue;
+        }
+        if (buf[pos + 1] == '\r' && pos + 2 < end && buf[pos + 2] == '\n') {
+          pos += 2;
+          continue;
+        }
+      }
+      tok.text += buf[pos];
+    }
+    if (pos >= end)
+      return tok;
+    pos++;
+    tok.kind = DotId;
+  } else if (c == '-' && pos + 1 < end &&
+             (buf[pos + 1] == '>' || buf[pos + 1] == '-')) {
+    tok.kind = DotEdgeOp;
+    tok.text = buf.substr(pos, 2);
+    pos += 2;
+  } else if (c == '{' || c == '}' || c == '[' || c == ']' || c == ';' ||
+             c == ',' || c == '=' || c == ':') {
+    tok.kind = DotPunct;
+    tok.punct = c;
+    pos++;
+  } else if (isIdChar(c) ||
+             (c == '-' && pos + 1 < end &&
+              (std::isdigit((unsigned char)buf[pos + 1]) ||
+               buf[pos + 1] == '.'))) {
+    std::size_t start = pos++;
+    while (pos < end && isIdChar(buf[pos]))
+      pos++;
+    tok.kind = DotId;
+    tok.text = buf.substr(start, pos - start);
+  }
+  // Anything else (HTML strings, '+' concatenation, ...) is DotBad
+  return tok;
+}
+
+/** Chunk parser */
+
+class DotChunkParser {
+public:
+  DotChunkParser(const std::string &buf, DotChunk &chunk)
+      : chunk(chunk), lex(buf, chunk.begin, chunk.end), depth(chunk.depth) {}
+  bool parse();
+
+private:
+  DotChunk &chunk;
+  DotLexer lex;
+  DotToken tok;
+  int depth;
+
+  void advance() { tok = lex.next(); }
+  bool isPunct(char c) { return tok.kind == DotPunct && tok.punct == c; }
+  bool isKeyword(const char *kw);
+  bool parseHeader();
+  bool parseAttrList(DotAttrList &attrs);
+  int intern(const std::string &name);
+};
+
+bool DotChunkParser::isKeyword(const char *kw) {
+  if (tok.kind != DotId || tok.quoted)
+    return false;
+  std::string lower(tok.text);
+  std::transform(lower.begin(), lower.end(), lower.begin(),
+                 [](unsigned char c) { return std::tolower(c); });
+  return lower == kw;
+}
+
+int DotChunkParser::intern(const std::string &name) {
+  auto it = chunk.local.find(name);
+  if (it != chunk.local.end())
+    return it->second;
+  int index = chunk.names.size();
+  chunk.local[name] = index;
+  chunk.names.push_back(name);
+  return index;
+}
+
+bool DotChunkParser::parseHeader() {
+  chunk.hasHeader = true;
+  chunk.strict = isKeyword("strict");
+  if (chunk.strict)
+    advance();
+  if (isKeyword("digraph"))
+    chunk.directed = true;
+  else if (isKeyword("graph"))
+    chunk.directed = false;
+  else
+    return false;
+  advance();
+  if (tok.kind == DotId) {
+    chunk.graphName = tok.text;
+    advance();
+  }
+  if (!isPunct('{'))
+    return false;
+  depth++;
+  advance();
+  return true;
+}
+
+bool DotChunkParser::parseAttrList(DotAttrList &attrs) {
+  while (isPunct('[')) {
+    advance();
+    while (!isPunct(']')) {
+      if (isPunct(',') || isPunct(';')) {
+        advance();
+        continue;
+      }
+      if (tok.kind != DotId)
+        return false;
+      std::string key = tok.text;
+      std::string value("true");
+      advance();
+      if (isPunct('=')) {
+        advance();
+        if (tok.kind != DotId)
+          return false;
+        value = tok.text;
+        advance();
+      }
+      attrs.push_back(std::make_pair(key, value));
+    }
+    advance();
+  }
+  return true;
+}
+
+bool DotChunkParser::parse() {
+  advance();
+  while (tok.kind != DotEnd) {
+    if (tok.kind == DotBad)
+      return false;
+    if (depth == 0) {
+      // Only the header may appear outside of the graph body
+      if (chunk.hasHeader || !parseHeader())
+        return false;
+      continue;
+    }
+    if (isPunct(';')) {
+      advance();
+    } else if (isPunct('}')) {
+      depth--;
+      advance();
+      if (depth == 0 && tok.kind != DotEnd)
+        return false; // more than one graph in the file
+    } else if (isPunct('{')) {
+      // An anonymous subgraph
+      if (depth == 1)
+        chunk.subgraphs.push_back(std::make_pair(false, std::string()));
+      depth++;
+      advance();
+    } else if (isKeyword("subgraph")) {
+      advance();
+      std::pair<bool, std::string> subgraph(false, std::string());
+      if (tok.kind == DotId) {
+        subgraph = std::make_pair(true, tok.text);
+        advance();
+      }
+      if (!isPunct('{'))
+        return false;
+      if (depth == 1)
+        chunk.subgraphs.push_back(subgraph);
+      depth++;
+      advance();
+    } else if (isKeyword("graph")) {
+      advance();
+      DotAttrList attrs;
+      if (!isPunct('[') || !parseAttrList(attrs))
+        return false;
+      // Attributes of subgraphs are dropped with the subgraphs themselves
+      if (depth == 1)
+        chunk.graphAttrs.insert(chunk.graphAttrs.end(), attrs.begin(),
+                                attrs.end());
+    } else if (isKeyword("node") || isKeyword("edge")) {
+      // Defaults depend on statement order across chunks
+      return false;
+    } else if (tok.kind == DotId) {
+      std::string name = tok.text;
+      advance();
+      if (isPunct(':'))
+        return false;
+      if (isPunct('=')) {
+        advance();
+        if (tok.kind != DotId)
+          return false;
+        if (depth == 1)
+          chunk.graphAttrs.push_back(std::make_pair(name, tok.text));
+        advance();
+        continue;
+      }
+      std::vector<int> chain(1, intern(name));
+      while (tok.kind == DotEdgeOp) {
+        advance();
+        if (tok.kind != DotId || isKeyword("subgraph"))
+          return false;
+        chain.push_back(intern(tok.text));
+        advance();
+        if (isPunct(':'))
+          return false;
+      }
+      DotAttrList attrs;
+      if (!parseAttrList(attrs))
+        return false;
+      if (chain.size() == 1) {
+        DotNodeStmt stmt;
+        stmt.node = chain[0];
+        stmt.attrs = attrs;
+        chunk.nodes.push_back(stmt);
+      }
+      for (std::size_t i = 0; i + 1 < chain.size(); i++) {
+        DotEdgeStmt stmt;
+        stmt.tail = chain[i];
+        stmt.head = chain[i + 1];
+        stmt.attrs = attrs;
+        chunk.edges.push_back(stmt);
+      }
+    } else {
+      return false;
+    }
+  }
+  return true;
+}
+
+/** Concurrent node table */
+
+class DotNodeTable {
+public:
+  explicit DotNodeTable(std::size_t count);
+  /** @brief returns the record of the name of rec, inserting rec if the name
+   * is new, and lowers the first mention of the stored record to rec's */
+  DotNodeRecord *insert(DotNodeRecord *rec);
+
+private:
+  std::size_t mask;
+  std::unique_ptr<std::atomic<DotNodeRecord *>[]> slots;
+};
+
+DotNodeTable::DotNodeTable(std::size_t count) {
+  std::size_t capacity = 16;
+  while (capacity < 2 * count)
+    capacity <<= 1;
+  mask = capacity - 1;
+  slots.reset(new std::atomic<DotNodeRecord *>[capacity]());
+}
+
+DotNodeRecord *DotNodeTable::insert(DotNodeRecord *rec) {
+  std::size_t i = rec->hash & mask;
+  while (true) {
+    DotNodeRecord *cur = slots[i].load(std::memory_order_acquire);
+    if (!cur) {
+      if (slots[i].compare_exchange_strong(cur, rec, std::memory_order_acq_rel,
+                                           std::memory_order_acquire))
+        return rec;
+      // cur now holds the record that took the slot first
+    }
+    if (cur->hash == rec->hash && *cur->name == *rec->name) {
+      std::uint64_t first = rec->first.load(std::memory_order_relaxed);
+      std::uint64_t seen = cur->first.load(std::memory_order_relaxed);
+      while (first < seen && !cur->first.compare_exchange_weak(seen, first))
+        ;
+      return cur;
+    }
+    i = (i + 1) & mask;
+  }
+}
+
+/** Driver */
+
+template <typename F> static void runJobs(std::size_t count, F job) {
+  std::vector<std::thread> workers;
+  for (std::size_t i = 1; i < count; i++)
+    workers.push_back(std::thread(job, i));
+  if (count)
+    job(0);
+  for (auto &worker : workers)
+    worker.join();
+}
+
+Agraph_t *readDotParallel(std::string filePath, int jobs) {
+  FILE *f = fopen(filePath.c_str(), "rb");
+  if (!f)
+    return nullptr;
+  std::string buf;
+  char block[1 << 16];
+  std::size_t n;
+  while ((n = fread(block, 1, sizeof(block), f)) > 0)
+    buf.append(block, n);
+  fclose(f);
+
+  int cores = std::thread::hardware_concurrency();
+  if (cores > 0 && jobs > cores)
+    jobs = cores;
+  std::vector<DotChunk> chunks;
+  int finalDepth;
+  splitStatements(buf, std::max(jobs, 1), chunks, finalDepth);
+  if (finalDepth != 0)
+    return nullptr;
+
+  // Parse every chunk into its own buffers
+  runJobs(chunks.size(), [&](std::size_t c) {
+    DotChunk &chunk = chunks[c];
+    chunk.failed = !DotChunkParser(buf, chunk).parse();
+  });
+  if (!chunks[0].hasHeader)
+    return nullptr;
+  std::size_t mentions = 0;
+  for (auto &chunk : chunks) {
+    if (chunk.failed || (&chunk != &chunks[0] && chunk.hasHeader))
+      return nullptr;
+    mentions += chunk.names.size();
+  }
+
+  // Resolve the node names of every chunk in the shared table
+  DotNodeTable table(mentions);
+  std::hash<std::string> hasher;
+  runJobs(chunks.size(), [&](std::size_t c) {
+    DotChunk &chunk = chunks[c];
+    chunk.records.reset(new DotNodeRecord[chunk.names.size()]);
+    chunk.resolved.resize(chunk.names.size());
+    for (std::size_t i = 0; i < chunk.names.size(); i++) {
+      DotNodeRecord *rec = &chunk.records[i];
+      rec->name = &chunk.names[i];
+      rec->hash = hasher(chunk.names[i]);
+      rec->first.store(((std::uint64_t)c << 32) | i, std::memory_order_relaxed);
+      rec->id = -1;
+      chunk.resolved[i] = table.insert(rec);
+    }
+  });
+
+  // Number the nodes in the order of their first mention in the file
+  std::vector<DotNodeRecord *> order;
+  for (auto &chunk : chunks)
+    for (std::size_t i = 0; i < chunk.names.size(); i++)
+      if (chunk.resolved[i] == &chunk.records[i])
+        order.push_back(&chunk.records[i]);
+  std::sort(order.begin(), order.end(),
+            [](const DotNodeRecord *a, const DotNodeRecord *b) {
+              return a->first.load(std::memory_order_relaxed) <
+                     b->first.load(std::memory_order_relaxed);
+            });
+  for (std::size_t id = 0; id < order.size(); id++)
+    order[id]->id = id;
+  runJobs(chunks.size(), [&](std::size_t c) {
+    DotChunk &chunk = chunks[c];
+    chunk.ids.resize(chunk.names.size());
+    for (std::size_t i = 0; i < chunk.names.size(); i++)
+      chunk.ids[i] = chunk.resolved[i]->id;
+  });
+
+  // Build the graph in file order
+  DotChunk &head = chunks[0];
+  Agdesc_t desc;
+  if (head.directed)
+    desc = head.strict ? Agstrictdirected : Agdirected;
+  else
+    desc = head.strict ? Agstrictundirected : Agundirected;
+  Agraph_t *g = agopen((char *)head.graphName.c_str(), desc, nullptr);
+  for (auto &chunk : chunks)
+    for (auto &attr : chunk.graphAttrs)
+      agattr(g, AGRAPH, (char *)attr.first.c_str(),
+             (char *)attr.second.c_str());
+  // The subgraphs of the root graph are created, empty, so that agnsubg does
+  // not depend on the number of jobs
+  for (auto &chunk : chunks)
+    for (auto &subgraph : chunk.subgraphs)
+      agsubg(g, subgraph.first ? (char *)subgraph.second.c_str() : nullptr,
+             TRUE);
+  std::vector<Agnode_t *> nodes(order.size());
+  for (std::size_t id = 0; id < order.size(); id++)
+    nodes[id] = agnode(g, (char *)order[id]->name->c_str(), TRUE);
+  for (auto &chunk : chunks) {
+    for (auto &stmt : chunk.nodes)
+      for (auto &attr : stmt.attrs)
+        agsafeset(nodes[chunk.ids[stmt.node]], (char *)attr.first.c_str(),
+                  (char *)attr.second.c_str(), (char *)"");
+    for (auto &stmt : chunk.edges) {
+      Agedge_t *e = agedge(g, nodes[chunk.ids[stmt.tail]],
+                           nodes[chunk.ids[stmt.head]], nullptr, TRUE);
+      for (auto &attr : stmt.attrs)
+        agsafeset(e, (char *)attr.first.c_str(), (char *)attr.second.c_str(),
+                  (char *)"");
+    }
+  }
+  return g;
+}
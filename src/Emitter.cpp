@@ -0,0 +1,93 @@
+/** @file Emitter.cpp
+ *  @brief Emitter tables for Emitter.h
+ *
+ *  Nodes are dispatched on BLIFCircuit::Type, and Operator nodes additionally
+ * on BLIFCircuit::Op. Entry and Exit nodes are printed in .inputs/.outputs
+ * so their subckt is always skipped.
+ */
+#include "../include/Emitter.h"
+#include <cstring>
+
+static const BLIFCircuit::SubcktEmitter typeEmitters[BLIFCircuit::_Error] = {
+    nullptr, // Operator, dispatched by op
+    &SubcktEmitterImpl<BLIFCircuit::Buffer>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Constant>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Fork>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Merge>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Select>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Branch>::emit,
+    &SubcktEmitterImpl<BLIFCircuit::Demux>::emit,
+    &emitSkipped, // Entry
+    &emitSkipped  // Exit
+};
+
+static const BLIFCircuit::SubcktEmitter opEmitters[BLIFCircuit::_ErrorOp] = {
+    &OperatorEmitterImpl<BLIFCircuit::load>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::store>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::mul>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::add>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::icmp>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::sub>::emit,
+    &OperatorEmitterImpl<BLIFCircuit::and_>::emit};
+
+BLIFCircuit::SubcktEmitter getSubcktEmitter(BLIFCircuit::NodeAttr_t *attrs) {
+  if (!attrs->valid)
+    return &emitSkipped;
+  if (attrs->type == BLIFCircuit::Operator)
+    return opEmitters[attrs->op];
+  return typeEmitters[attrs->type];
+}
+
+void BitSuffixTable::reserve(int width) {
+  for (int i = offset.size() - 1; i < width; i++) {
+    text += '[';
+    text += std::to_string(i);
+    text += ']';
+    offset.push_back(text.size());
+  }
+}
+
+void appendBitBindings(std::string &buf, BitSuffixTable &bits,
+                       const std::string &name, const std::string &net,
+                       int width) {
+  if (width <= 0)
+    return;
+  bits.reserve(width);
+  // Size the whole channel once, then copy every fragment into place
+  std::size_t pos = buf.size();
+  buf.resize(pos + width * (name.size() + net.size() + 2) +
+             2 * bits.totalLength(width));
+  char *out = &buf[pos];
+  for (int i = 0; i < width; i++) {
+    const char *suffix = bits.suffix(i);
+    std::size_t len = bits.length(i);
+    std::memcpy(out, name.data(), name.size());
+    out += name.size();
+    std::memcpy(out, suffix, len);
+    out += len;
+    *out++ = '=';
+    std::memcpy(out, net.data(), net.size());
+    out += net.size();
+    std::memcpy(out, suffix, len);
+    out += len;
+    *out++ = ' ';
+  }
+}
+
+void appendBitNets(std::string &buf, BitSuffixTable &bits,
+                   const std::string &net, int width) {
+  if (width <= 0)
+    return;
+  bits.reserve(width);
+  std::size_t pos = buf.size();
+  buf.resize(pos + width * (net.size() + 1) + bits.totalLength(width));
+  char *out = &buf[pos];
+  for (int i = 0; i < width; i++) {
+    std::size_t len = bits.length(i);
+    std::memcpy(out, net.data(), net.size());
+    out += net.size();
+    std::memcpy(out, bits.suffix(i), len);
+    out += len;
+    *out++ = ' ';
+  }
+}
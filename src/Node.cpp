@@ -8,6 +8,9 @@
  * @bug setName and setType methods have redundant arguments
  */
 #include "../include/Node.h"
+#include "../include/DotReader.h"
+#include "../include/Emitter.h"
+#include <cctype>
 #include <chrono>
 #include <ctime>
 #include <fstream>
@@ -16,13 +19,24 @@
 #include <sstream>
 #include <string>
 
-Agraph_t *parseDotFile(std::string filePath, int verbosity) {
+Agraph_t *parseDotFile(std::string filePath, int verbosity, int jobs) {
 
-  FILE *f;
-  // Read graph from file
-  f = fopen(filePath.c_str(), "r");
-  Agraph_t *g = agread(f, nullptr);
-  fclose(f);
+  Agraph_t *g = nullptr;
+  if (jobs > 1) {
+    g = readDotParallel(filePath, jobs);
+    if (!g)
+      std::cout << "Warning: " << filePath
+                << " can not be split into statements, reading it on a "
+                   "single thread"
+                << std::endl;
+  }
+  if (!g) {
+    FILE *f;
+    // Read graph from file
+    f = fopen(filePath.c_str(), "r");
+    g = agread(f, nullptr);
+    fclose(f);
+  }
   // Traverse nodes and print some info
   if (verbosity > 0) {
     std::cout << "Read graph " << agnameof(g) << " from file:" << filePath
@@ -66,7 +80,7 @@ std::string get_indent_string(int indent) {
   return indent_str;
 }
 
-void BLIFCircuit::parseAttributes() {
+void BLIFCircuit::setChannelWidth() {
   Agsym_t *globalSym = agattrsym(graph, "channel_width");
 
   if (!globalSym) {
@@ -77,6 +91,10 @@ void BLIFCircuit::parseAttributes() {
     std::istringstream conv(std::string(agget(graph, "channel_width")));
     conv >> channelWidth;
   }
+}
+
+void BLIFCircuit::parseAttributes() {
+  setChannelWidth();
   // Traverse nodes to get attributes
   for (Agnode_t *n = agfstnode(graph); n; n = agnxtnode(graph, n)) {
     // First we need to bind our desired attributes
@@ -143,8 +161,11 @@ void BLIFCircuit::genConnection(Agedge_t *e) {
   std::string headPort = agget(e, "to");
   NodeAttr_t *tailAttr = getAttributes(agtail(e));
   NodeAttr_t *headAttr = getAttributes(aghead(e));
-  BLIFIO *from = tailAttr->outPort->getBLIFIOByName(tailPort);
-  BLIFIO *to = headAttr->inPort->getBLIFIOByName(headPort);
+  BLIFIO *from = tailAttr->outPort
+                     ? tailAttr->outPort->getBLIFIOByName(tailPort)
+                     : NULL;
+  BLIFIO *to =
+      headAttr->inPort ? headAttr->inPort->getBLIFIOByName(headPort) : NULL;
   std::string connection = tailName + "." + tailPort + "*" + tailAttr->typeStr +
                            "*" + "~" + headName + "." + headPort + "*" +
                            headAttr->typeStr + "*";
@@ -156,14 +177,10 @@ void BLIFCircuit::genConnection(Agedge_t *e) {
   if (!to) {
     std::cout << "\tInvalid head " << headPort << " of " << headName << "\n";
   }
+  // Invalid edges are left unconnected and reported by validate()
   if (from && to) {
-    from->connection = connection;
-    to->connection = connection;
-  } else {
-    std::cerr << "Error: invalid edge connection from " << tailName << "("
-              << tailPort << ") to " << headName << "(" << headPort << ")"
-              << std::endl;
-    exit(0);
+    tailAttr->outPort->bind(from, connection);
+    headAttr->inPort->bind(to, connection);
   }
 }
 void BLIFCircuit::setName(Agnode_t *node) {
@@ -183,13 +200,16 @@ void BLIFCircuit::setType(Agnode_t *node) {
     attributes->name = std::string("NULL");
 
   } else if (t_ == _Error) {
-    std::cerr << "Error: unkown type \"" << typeStr << "\"\n";
-    exit(1);
+    // Reported by validate()
+    attributes->typeStr = typeStr;
   } else {
     attributes->typeStr = typeStr;
     if (t_ != Exit && t_ != Entry)
       attributes->valid = TRUE;
   }
+  // Operators are bound once their op is known, in setOp
+  if (t_ != Operator)
+    attributes->emitter = getSubcktEmitter(attributes);
 }
 void BLIFCircuit::setOp(Agnode_t *node) {
   NodeAttr_t *attrs = getAttributes(node);
@@ -197,15 +217,11 @@ void BLIFCircuit::setOp(Agnode_t *node) {
     std::string opStr(agget(node, "op"));
     opStr.erase(remove(opStr.begin(), opStr.end(), ' '), opStr.end());
     Op op_ = isValidOp(opStr);
-    if (op_ == _NullOp) {
-      std::cerr << "Operator op can not be NULL\n";
-      exit(1);
-    } else if (op_ == _ErrorOp) {
-      std::cerr << "Error: unkown op \"" << opStr << "\"\n";
-      exit(1);
-    } else {
-      attrs->op = op_;
-    }
+    attrs->op = op_;
+    // NULL and unknown ops are reported by validate()
+    if (op_ == _NullOp || op_ == _ErrorOp)
+      attrs->valid = FALSE;
+    attrs->emitter = getSubcktEmitter(attrs);
   }
 }
 BLIFCircuit::Type BLIFCircuit::isValidType(std::string typeStr) {
@@ -223,7 +239,7 @@ BLIFCircuit::Type BLIFCircuit::isValidType(std::string typeStr) {
 BLIFCircuit::Op BLIFCircuit::isValidOp(std::string opStr) {
   if (opStr.empty())
     return _NullOp;
-  for (int i = 0; i < 10; i++) {
+  for (int i = 0; i < _ErrorOp; i++) {
     if (opStr == Op_str[i]) {
       return (Op)i;
     }
@@ -291,7 +307,7 @@ BLIFCircuit::NodeAttr_t *BLIFCircuit::getAttributes(Agnode_t *n) {
   return (NodeAttr_t *)aggetrec(n, ATTR_STR, 0);
 }
 
-void BLIFCircuit::printCircuit(std::ostream &os, int indent) {
+void BLIFCircuit::printCircuit(std::ostream &os, int indent, bool bitBlast) {
 
   const std::string header("#### BLIF netlist of DFG circuit\n");
   std::string indent_str = get_indent_string(indent);
@@ -303,13 +319,26 @@ void BLIFCircuit::printCircuit(std::ostream &os, int indent) {
   os << indent_str << header;
   os << indent_str << ".model " << name << "\n";
 
-  printCircuitIO(os, indent + 1);
+  BitSuffixTable bits(channelWidth);
+  printCircuitIO(os, indent + 1, bitBlast ? &bits : nullptr);
+  EmitContext ctx;
+  ctx.indent = get_indent_string(indent + 2);
+  ctx.indentInner = get_indent_string(indent + 3);
+  ctx.bits = bitBlast ? &bits : nullptr;
+  std::string buf;
+  buf.reserve(EMIT_BUFFER_SIZE);
   for (Agnode_t *n = agfstnode(graph); n; n = agnxtnode(graph, n)) {
-    printSubckt(os, n, indent + 2);
+    printSubckt(buf, ctx, n);
+    if (buf.size() >= EMIT_BUFFER_SIZE) {
+      os.write(buf.data(), buf.size());
+      buf.clear();
+    }
   }
+  os.write(buf.data(), buf.size());
   os << indent_str << ".end\n";
 }
-void BLIFCircuit::printCircuitIO(std::ostream &os, int indent) {
+void BLIFCircuit::printCircuitIO(std::ostream &os, int indent,
+                                 BitSuffixTable *bits) {
   std::cout << "Printing node as entry node(input)\n";
   std::string indent_str = get_indent_string(indent);
   NodeAttr_t *attrs;
@@ -321,7 +350,13 @@ void BLIFCircuit::printCircuitIO(std::ostream &os, int indent) {
       std::cout << " of width " << attrs->width << std::endl;
       auto ios = attrs->outPort->getIOPointer();
       for (auto iter = ios->begin(); iter != ios->end(); iter++) {
-        os << indent_str << (*iter)->connection << " ";
+        os << indent_str;
+        if (bits) {
+          std::string nets;
+          appendBitNets(nets, *bits, (*iter)->connection, (*iter)->width);
+          os << nets;
+        } else
+          os << (*iter)->connection << " ";
       }
     }
   }
@@ -335,44 +370,41 @@ void BLIFCircuit::printCircuitIO(std::ostream &os, int indent) {
       std::cout << " of width " << attrs->width << std::endl;
       auto ios = attrs->inPort->getIOPointer();
       for (auto iter = ios->begin(); iter != ios->end(); iter++) {
-        os << indent_str << (*iter)->connection << " ";
+        os << indent_str;
+        if (bits) {
+          std::string nets;
+          appendBitNets(nets, *bits, (*iter)->connection, (*iter)->width);
+          os << nets;
+        } else
+          os << (*iter)->connection << " ";
       }
     }
   }
   os << "\n";
 }
 
-void BLIFCircuit::printSubckt(std::ostream &os, Agnode_t *model, int indent) {
-  std::string indent_str = get_indent_string(indent);
-  std::string indent_str_inner = get_indent_string(indent + 1);
+void BLIFCircuit::printSubckt(std::string &buf, const EmitContext &ctx,
+                              Agnode_t *model) {
   NodeAttr_t *attrs = getAttributes(model);
-  os << indent_str << "#Node " << attrs->name << std::endl;
-  if (attrs->valid) {
-    os << indent_str << ".subckt " << attrs->typeStr << "\\" << std::endl;
-    BLIFPort *inPort = attrs->inPort;
-
-    for (auto io : *inPort->getIOPointer()) {
-      if (!io->connection.empty())
-        os << indent_str_inner << io->name << "=" << io->connection << " ";
-    }
-
-    BLIFPort *outPort = attrs->outPort;
-    for (auto io : *outPort->getIOPointer()) {
-      if (!io->connection.empty())
-        os << indent_str_inner << io->name << "=" << io->connection << " ";
-    }
-    os << std::endl;
-  } else
-    os << indent_str << "#Skipped" << std::endl;
+  attrs->emitter(buf, ctx, attrs);
 }
 
-BLIFPort::BLIFPort(std::string expr, Agnode_t *n, bool _mode, int _defWidth) {
+BLIFPort::BLIFPort(std::string expr, Agnode_t *n, bool _mode, int _defWidth,
+                   bool _verbose) {
   mode = _mode;
   defWidth = _defWidth;
+  verbose = _verbose;
   node = n;
   io = new std::vector<BLIFIO *>;
+  bound = new std::vector<BLIFIO *>;
   parseExpr(expr);
 }
+BLIFPort::~BLIFPort() {
+  for (auto ioObj : *io)
+    delete ioObj;
+  delete io;
+  delete bound;
+}
 void BLIFPort::parseExpr(std::string expr) {
   /*
     the syntax for inputs and outputs are as follows:
@@ -399,18 +431,25 @@ void BLIFPort::parseExpr(std::string expr) {
     // std::cout << "lkhdpos: " << lkhdpos << std::endl;
     // std::cout << "clnpos: " << clnpos << std::endl;
     if (lkhdpos >= clnpos) {
-      // Look for digits
-      std::size_t dgtstrtpos = expr.find_first_of("0123456789", clnpos);
+      // Look for digits right after the colon
+      std::size_t dgtstrtpos = expr.find_first_not_of(' ', clnpos + 1);
 
       std::size_t dgtndpos =
           expr.find_first_not_of("0123456789", dgtstrtpos + 1);
 
       // std::cout << "dgtstrtpos: " << dgtstrtpos << std::endl;
       // std::cout << "dgtndpos: " << dgtndpos << std::endl;
-      if (dgtndpos <= dgtstrtpos) {
-        std::cerr << "Error: expected decimal width for node " << agnameof(node)
-                  << std::endl;
-        exit(0);
+      if (dgtstrtpos == std::string::npos ||
+          !std::isdigit((unsigned char)expr[dgtstrtpos])) {
+        // No width after the colon: parseStmnt records the statement with an
+        // invalid width for validate() and parsing goes on after it
+        std::size_t tkndpos = dgtstrtpos == std::string::npos
+                                  ? dgtstrtpos
+                                  : expr.find(' ', dgtstrtpos);
+        parseStmnt(expr.substr(0, tkndpos));
+        if (tkndpos != std::string::npos)
+          parseExpr(expr.substr(tkndpos));
+        return;
       }
 
       std::size_t nxtpos = expr.find_first_not_of(' ', dgtndpos + 1);
@@ -441,7 +480,8 @@ void BLIFPort::parseStmnt(std::string stmnt) {
   stmnt.erase(remove(stmnt.begin(), stmnt.end(), '?'), stmnt.end());
   if (stmnt.empty())
     return;
-  std::cout << "Parsing statement: " << stmnt << std::endl;
+  if (verbose)
+    std::cout << "Parsing statement: " << stmnt << std::endl;
   std::size_t clnpos = stmnt.find(':');
   std::string portName;
   BLIFIO *newIO = new BLIFIO;
@@ -459,22 +499,41 @@ void BLIFPort::parseStmnt(std::string stmnt) {
       conv >> w;
       newIO->width = w;
     } else {
-      std::cerr << "Error: \"" << stmnt.substr(clnpos + 1)
-                << "\" is not a number\n";
-      exit(0);
+      // Reported by validate()
+      newIO->width = -1;
     }
   }
+  newIO->index = io->size();
+  newIO->prefix = newIO->name + "=";
   io->push_back(newIO);
   // std::cout << "port name is " << newIO->name << std::endl;
 }
 bool BLIFPort::isValidNumber(std::string s) {
   // std::cout << "checking validity of " << s << std::endl;
   std::string::const_iterator it = s.begin();
-  while (it != s.end() && std::isdigit(*it))
+  while (it != s.end() && std::isdigit((unsigned char)*it))
     ++it;
   return !s.empty() && it == s.end();
 }
 
+void BLIFPort::bind(BLIFIO *ioObj, const std::string &connection) {
+  if (ioObj->connection.empty()) {
+    auto pos = bound->begin();
+    while (pos != bound->end() && (*pos)->index < ioObj->index)
+      pos++;
+    bound->insert(pos, ioObj);
+  }
+  ioObj->connection = connection;
+}
+
+int BLIFPort::getIndexByName(const std::string &name) {
+  for (std::size_t i = 0; i < io->size(); i++) {
+    if ((*io)[i]->name == name)
+      return i;
+  }
+  return -1;
+}
+
 BLIFIO *BLIFPort::getBLIFIOByName(std::string name) {
   for (auto &ioObj : *io) {
     if (ioObj->name == name)
@@ -496,15 +555,24 @@ void BLIFCircuit::makeFork2Single(Agnode_t *node, int level, int target_fanout,
 
     // create a node to replace the old fork node with big fanout
 
+    // Every port of the new fork is as wide as the input of the original one
+    NodeAttr_t *fork_attr = getAttributes(original_fork);
+    int width = fork_attr->inPort && fork_attr->inPort->ioCount()
+                    ? (*fork_attr->inPort->getIOPointer())[0]->width
+                    : channelWidth;
+    std::string width_str = ":" + std::to_string(width);
+    std::string in_expr = "in1" + width_str;
+    std::string out_expr = "out1" + width_str + " out2" + width_str;
+
     Agnode_t *new_node = agnode(graph, (char *)new_name.c_str(), true);
     // Append attribtues to the new node
     NodeAttr_t *new_attr = new NodeAttr_t;
     new_attr =
         (NodeAttr_t *)agbindrec(new_node, ATTR_STR, sizeof(NodeAttr_t), FALSE);
     std::cout << "\tsetting in1 input" << std::endl;
-    agset(new_node, "in", "in1");
+    agset(new_node, "in", (char *)in_expr.c_str());
     std::cout << "\tsetting out1 out2 outputs" << std::endl;
-    agset(new_node, "out", "out1 out2");
+    agset(new_node, "out", (char *)out_expr.c_str());
     std::cout << "\tsetting type to Fork" << std::endl;
     agset(new_node, "type", "Fork");
     std::cout << "\tsetting name to " << new_name << std::endl;
@@ -513,9 +581,8 @@ void BLIFCircuit::makeFork2Single(Agnode_t *node, int level, int target_fanout,
     setType(new_node);
 
     new_attr->outPort =
-        new BLIFPort(std::string("out1 out2"), new_node, TRUE, channelWidth);
-    new_attr->inPort =
-        new BLIFPort(std::string("in1"), new_node, FALSE, channelWidth);
+        new BLIFPort(out_expr, new_node, TRUE, channelWidth);
+    new_attr->inPort = new BLIFPort(in_expr, new_node, FALSE, channelWidth);
 
     std::cout << "New node generation succeeded" << std::endl;
     // Creating an edge between the new node and node.
@@ -597,6 +664,7 @@ void BLIFCircuit::makeFork2() {
       makeFork2Single(predecessor, 0, attr->outPort->ioCount(), 0,
                       std::string(agnameof(n)), n, successors);
       attr->valid = FALSE;
+      attr->emitter = getSubcktEmitter(attr);
       std::cout << "Fork transformation generation succeeded" << std::endl;
     }
   }
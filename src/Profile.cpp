@@ -0,0 +1,123 @@
+/** @file Profile.cpp
+ *  @brief Graph profile of BLIFCircuit
+ *
+ *  The profile is gathered in a single pass over the nodes, straight from the
+ * DOT attributes, without binding records or emitting BLIF. The predicted
+ * counts follow the transformations of the normal flow: every store gets an
+ * inferred Exit node and edge (see getIOs), and every Fork with k > 2 outputs
+ * is expanded by makeFork2 into k - 1 Fork2 nodes and 2k - 1 edges while the
+ * original fork is kept in the graph but no longer emitted.
+ */
+#include "../include/Node.h"
+#include <algorithm>
+#include <map>
+#include <string>
+
+typedef std::map<std::string, long> NamedHistogram;
+typedef std::map<long, long> Histogram;
+
+static std::string jsonString(const std::string &s) {
+  std::string out("\"");
+  for (char c : s) {
+    if (c == '"' || c == '\\')
+      out += '\\';
+    if ((unsigned char)c < 0x20)
+      continue;
+    out += c;
+  }
+  return out + "\"";
+}
+
+static void printHistogram(std::ostream &os, const std::string &name,
+                           const NamedHistogram &h, bool last = false) {
+  os << "  " << jsonString(name) << ": {";
+  for (auto it = h.begin(); it != h.end(); it++)
+    os << (it == h.begin() ? "" : ", ") << jsonString(it->first) << ": "
+       << it->second;
+  os << "}" << (last ? "\n" : ",\n");
+}
+
+static void printHistogram(std::ostream &os, const std::string &name,
+                           const Histogram &h, bool last = false) {
+  os << "  " << jsonString(name) << ": {";
+  for (auto it = h.begin(); it != h.end(); it++)
+    os << (it == h.begin() ? "" : ", ") << "\"" << it->first
+       << "\": " << it->second;
+  os << "}" << (last ? "\n" : ",\n");
+}
+
+void BLIFCircuit::profile(std::ostream &os) {
+  setChannelWidth();
+  NamedHistogram types, ops;
+  Histogram fanin, fanout, forkOutputs, widths;
+  long nodes = 0, edges = agnedges(graph), ports = 0, subckts = 0;
+  long newNodes = 0, newEdges = 0;
+
+  for (Agnode_t *n = agfstnode(graph); n; n = agnxtnode(graph, n)) {
+    nodes++;
+    fanin[agdegree(graph, n, TRUE, FALSE)]++;
+    fanout[agdegree(graph, n, FALSE, TRUE)]++;
+
+    char *typeAttr = agget(n, "type");
+    std::string typeStr(typeAttr ? typeAttr : "");
+    typeStr.erase(remove(typeStr.begin(), typeStr.end(), ' '), typeStr.end());
+    Type type = isValidType(typeStr);
+    types[type == _Null ? std::string("_untyped") : typeStr]++;
+    if (type == _Null || type == _Error)
+      continue;
+    if (type != Entry && type != Exit)
+      subckts++;
+
+    if (type == Operator) {
+      char *opAttr = agget(n, "op");
+      std::string opStr(opAttr ? opAttr : "");
+      opStr.erase(remove(opStr.begin(), opStr.end(), ' '), opStr.end());
+      ops[opStr.empty() ? std::string("_untyped") : opStr]++;
+      if (isValidOp(opStr) == store) {
+        newNodes++;
+        newEdges++;
+      }
+    }
+
+    int outputs = 0;
+    for (int mode = FALSE; mode <= TRUE; mode++) {
+      char *expr = agget(n, (char *)(mode ? "out" : "in"));
+      if (!expr || std::string(expr).find_first_not_of(' ') ==
+                       std::string::npos)
+        continue;
+      BLIFPort port(expr, n, mode, channelWidth, false);
+      for (auto io : *port.getIOPointer())
+        widths[io->width]++;
+      ports += port.ioCount();
+      if (mode)
+        outputs = port.ioCount();
+    }
+
+    if (type == Fork) {
+      forkOutputs[outputs]++;
+      if (outputs > 2) {
+        newNodes += outputs - 1;
+        newEdges += 2 * outputs - 1;
+        subckts += outputs - 2;
+      }
+    }
+  }
+
+  os << "{\n";
+  os << "  \"graph\": " << jsonString(agnameof(graph)) << ",\n";
+  os << "  \"channel_width\": " << channelWidth << ",\n";
+  os << "  \"nodes\": " << nodes << ",\n";
+  os << "  \"edges\": " << edges << ",\n";
+  os << "  \"subgraphs\": " << agnsubg(graph) << ",\n";
+  os << "  \"ports\": " << ports << ",\n";
+  printHistogram(os, "types", types);
+  printHistogram(os, "ops", ops);
+  printHistogram(os, "fanin", fanin);
+  printHistogram(os, "fanout", fanout);
+  printHistogram(os, "fork_outputs", forkOutputs);
+  printHistogram(os, "port_widths", widths);
+  os << "  \"predicted\": {\"nodes\": " << nodes + newNodes
+     << ", \"edges\": " << edges + newEdges << ", \"subckts\": " << subckts
+     << "}\n";
+  os << "}\n";
+}
@@ -0,0 +1,215 @@
+/** @file Validator.cpp
+ *  @brief Connectivity checks of BLIFCircuit
+ *
+ *  The graph is copied into plain arrays in one serial pass first, since
+ * cgraph traversals can not be shared between threads. After that every node
+ * is checked against its own in and out edges only, so the nodes are split
+ * between threads and the reports are concatenated in node order. Each edge
+ * is looked at once from each of its ends, which keeps the check O(V+E).
+ */
+#include "../include/Node.h"
+#include <sstream>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct ValidatorNode {
+  std::string name;
+  std::string opStr;
+  BLIFCircuit::NodeAttr_t *attrs;
+  std::vector<int> inEdges;
+  std::vector<int> outEdges;
+};
+
+struct ValidatorEdge {
+  int tail;
+  int head;
+  std::string from;
+  std::string to;
+};
+
+// Nodes of unknown type or op already have an error of their own
+static bool isBroken(BLIFCircuit::NodeAttr_t *attrs) {
+  return attrs->type == BLIFCircuit::_Error ||
+         (attrs->type == BLIFCircuit::Operator &&
+          (attrs->op == BLIFCircuit::_ErrorOp ||
+           attrs->op == BLIFCircuit::_NullOp));
+}
+
+static int checkWidths(std::ostream &err, const std::string &name,
+                       BLIFPort *port) {
+  int count = 0;
+  if (!port)
+    return count;
+  for (auto io : *port->getIOPointer()) {
+    if (io->width <= 0) {
+      err << "Error: invalid width of port " << io->name << " of node "
+          << name << "\n";
+      count++;
+    }
+  }
+  return count;
+}
+
+int BLIFCircuit::validate(std::ostream &os, int jobs) {
+  std::vector<ValidatorNode> nodes;
+  std::vector<ValidatorEdge> edges;
+  std::unordered_map<Agnode_t *, int> index;
+  for (Agnode_t *n = agfstnode(graph); n; n = agnxtnode(graph, n)) {
+    index[n] = nodes.size();
+    ValidatorNode node;
+    node.name = agnameof(n);
+    node.attrs = getAttributes(n);
+    if (node.attrs->type == Operator)
+      node.opStr = agget(n, "op");
+    nodes.push_back(node);
+  }
+  for (Agnode_t *n = agfstnode(graph); n; n = agnxtnode(graph, n)) {
+    for (Agedge_t *e = agfstout(graph, n); e; e = agnxtout(graph, e)) {
+      ValidatorEdge edge;
+      edge.tail = index[n];
+      edge.head = index[aghead(e)];
+      char *from = agget(e, "from");
+      char *to = agget(e, "to");
+      edge.from = from ? from : "";
+      edge.to = to ? to : "";
+      nodes[edge.tail].outEdges.push_back(edges.size());
+      nodes[edge.head].inEdges.push_back(edges.size());
+      edges.push_back(edge);
+    }
+  }
+
+  int cores = std::thread::hardware_concurrency();
+  if (cores > 0 && jobs > cores)
+    jobs = cores;
+  if (jobs > (int)nodes.size())
+    jobs = nodes.size();
+  if (jobs < 1)
+    jobs = 1;
+  std::vector<std::string> reports(jobs);
+  std::vector<int> counts(jobs, 0);
+
+  auto check = [&](int job) {
+    std::ostringstream err;
+    int count = 0;
+    // Bitsets over the port indices of the node being checked
+    std::vector<bool> driven, used;
+    std::size_t begin = nodes.size() * job / jobs;
+    std::size_t end = nodes.size() * (job + 1) / jobs;
+    for (std::size_t i = begin; i < end; i++) {
+      const ValidatorNode &node = nodes[i];
+      NodeAttr_t *attrs = node.attrs;
+      if (attrs->type == _Null)
+        continue;
+      if (attrs->type == _Error) {
+        err << "Error: unknown type \"" << attrs->typeStr << "\" of node "
+            << node.name << "\n";
+        count++;
+        continue;
+      }
+      if (isBroken(attrs)) {
+        if (attrs->op == _NullOp)
+          err << "Error: Operator node " << node.name << " has no op\n";
+        else
+          err << "Error: unknown op \"" << node.opStr << "\" of node "
+              << node.name << "\n";
+        count++;
+        continue;
+      }
+      BLIFPort *inPort = attrs->inPort;
+      BLIFPort *outPort = attrs->outPort;
+      count += checkWidths(err, node.name, inPort);
+      count += checkWidths(err, node.name, outPort);
+      driven.assign(inPort ? inPort->ioCount() : 0, false);
+      used.assign(outPort ? outPort->ioCount() : 0, false);
+
+      for (int id : node.inEdges) {
+        const ValidatorEdge &edge = edges[id];
+        const ValidatorNode &tail = nodes[edge.tail];
+        if (tail.attrs->type == _Null) {
+          err << "Error: edge from untyped node " << tail.name << " to "
+              << node.name << "(" << edge.to << ")\n";
+          count++;
+          continue;
+        }
+        int k = inPort ? inPort->getIndexByName(edge.to) : -1;
+        if (k < 0) {
+          err << "Error: edge from " << tail.name << "(" << edge.from
+              << ") to unknown input \"" << edge.to << "\" of node "
+              << node.name << "\n";
+          count++;
+          continue;
+        }
+        if (driven[k]) {
+          err << "Error: input " << edge.to << " of node " << node.name
+              << " is driven more than once\n";
+          count++;
+        }
+        driven[k] = true;
+        BLIFPort *tailPort = tail.attrs->outPort;
+        int j = tailPort ? tailPort->getIndexByName(edge.from) : -1;
+        if (j < 0)
+          continue; // reported from the tail, unless the tail is broken
+        int tailWidth = (*tailPort->getIOPointer())[j]->width;
+        int headWidth = (*inPort->getIOPointer())[k]->width;
+        if (tailWidth > 0 && headWidth > 0 && tailWidth != headWidth) {
+          err << "Error: width mismatch on edge " << tail.name << "("
+              << edge.from << ":" << tailWidth << ") to " << node.name << "("
+              << edge.to << ":" << headWidth << ")\n";
+          count++;
+        }
+      }
+
+      for (int id : node.outEdges) {
+        const ValidatorEdge &edge = edges[id];
+        const ValidatorNode &head = nodes[edge.head];
+        if (head.attrs->type == _Null) {
+          err << "Error: edge from " << node.name << "(" << edge.from
+              << ") to untyped node " << head.name << "\n";
+          count++;
+          continue;
+        }
+        int k = outPort ? outPort->getIndexByName(edge.from) : -1;
+        if (k < 0) {
+          err << "Error: edge from unknown output \"" << edge.from
+              << "\" of node " << node.name << " to " << head.name << "("
+              << edge.to << ")\n";
+          count++;
+          continue;
+        }
+        used[k] = true;
+      }
+
+      for (std::size_t k = 0; k < driven.size(); k++) {
+        if (!driven[k]) {
+          err << "Error: input " << (*inPort->getIOPointer())[k]->name
+              << " of node " << node.name << " is dangling\n";
+          count++;
+        }
+      }
+      for (std::size_t k = 0; k < used.size(); k++) {
+        if (!used[k]) {
+          err << "Error: output " << (*outPort->getIOPointer())[k]->name
+              << " of node " << node.name << " is dangling\n";
+          count++;
+        }
+      }
+    }
+    reports[job] = err.str();
+    counts[job] = count;
+  };
+
+  std::vector<std::thread> workers;
+  for (int job = 1; job < jobs; job++)
+    workers.push_back(std::thread(check, job));
+  check(0);
+  for (auto &worker : workers)
+    worker.join();
+
+  int errors = 0;
+  for (int job = 0; job < jobs; job++) {
+    os << reports[job];
+    errors += counts[job];
+  }
+  return errors;
+}
@@ -1,18 +1,61 @@
 #include "Node.h"
+#include <cstdlib>
 #include <regex>
 #include <fstream>
 #include <iostream>
 #include <vector>
 int main(int argc, char **argv){
-  Agraph_t *g = parseDotFile(argv[1], 1);
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0]
+              << " <graph.dot> [--bit-blast] [--jobs N] [--profile out.json]"
+              << std::endl;
+    return 1;
+  }
+  bool bitBlast = false;
+  int jobs = 1;
+  std::string profilePath;
+  for (int i = 2; i < argc; i++) {
+    std::string arg(argv[i]);
+    if (arg == "--bit-blast") {
+      bitBlast = true;
+    } else if (arg == "--jobs" && i + 1 < argc) {
+      jobs = std::atoi(argv[++i]);
+    } else if (arg == "--profile" && i + 1 < argc) {
+      profilePath = argv[++i];
+    } else {
+      std::cerr << "Error: unknown option \"" << arg << "\"" << std::endl;
+      return 1;
+    }
+  }
+  Agraph_t *g = parseDotFile(argv[1], profilePath.empty() ? 1 : 0, jobs);
   BLIFCircuit circ(g, "my_circuit");
+  if (!profilePath.empty()) {
+    std::ofstream profile(profilePath.c_str(), std::ios::out);
+    if (!profile) {
+      std::cerr << "Error: can not open \"" << profilePath << "\"" << std::endl;
+      return 1;
+    }
+    circ.profile(profile);
+    profile.close();
+    if (!profile) {
+      std::cerr << "Error: can not write \"" << profilePath << "\""
+                << std::endl;
+      return 1;
+    }
+    return 0;
+  }
+  circ.parseAttributes();
+  int errors = circ.validate(std::cerr, jobs);
+  if (errors) {
+    std::cerr << errors << " error(s) found" << std::endl;
+    return 1;
+  }
   std::ofstream os;
   os.open("../my_circuit.blif", std::ios::out);
-  circ.parseAttributes();
   std::cout << "attributes parsed successfully\n";
   circ.makeFork2();
   std::cout << "haha" << std::endl;
-  circ.printCircuit(os);
+  circ.printCircuit(os, 0, bitBlast);
   std::vector <int> a; a.push_back(1); a.push_back(2); a.push_back(3);
   std::cout << a.back() << std::endl;
   a.pop_back();
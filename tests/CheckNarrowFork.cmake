@@ -0,0 +1,18 @@
+# BLIFMaker writes ../my_circuit.blif, so it is run one level below WORK_DIR
+file(REMOVE_RECURSE ${WORK_DIR})
+file(MAKE_DIRECTORY ${WORK_DIR}/run)
+execute_process(COMMAND ${BLIFMAKER} ${DOT} --bit-blast
+                WORKING_DIRECTORY ${WORK_DIR}/run
+                RESULT_VARIABLE result
+                OUTPUT_QUIET)
+if(NOT result EQUAL 0)
+  message(FATAL_ERROR "BLIFMaker exited with ${result}")
+endif()
+
+file(READ ${WORK_DIR}/my_circuit.blif blif)
+if(NOT blif MATCHES "#Node f_l0_c0\n[^\n]*\\.subckt Fork")
+  message(FATAL_ERROR "the fork was not split into Fork2 nodes:\n${blif}")
+endif()
+if(blif MATCHES "\\[1\\]")
+  message(FATAL_ERROR "a 1-bit channel was blasted into several bits:\n${blif}")
+endif()